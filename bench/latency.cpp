@@ -0,0 +1,160 @@
+// Measure the latency of commands in the interactive mode of `dice`, by
+// driving it through a pair of pipes in the same way as a script would.
+//
+// Usage: latency <path-to-dice> [<number-of-commands>]
+//
+// Each command is written to the program's standard input, and the time is
+// measured until the next ">>> " prompt is read back. The 50th and 99th
+// percentiles of these times are then printed. This requires POSIX.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+	using clock_type = std::chrono::steady_clock;
+
+	/// A running instance of `dice`, connected through pipes.
+	struct child {
+		pid_t pid;
+		int in;   // Write end of the program's standard input.
+		int out;  // Read end of the program's standard output.
+	};
+
+	/// Start `path` in interactive mode with a fixed seed and two d6's.
+	child spawn(char const* path)
+	{
+		int to_child[2], from_child[2];
+		if (pipe(to_child) != 0 || pipe(from_child) != 0) {
+			std::perror("pipe");
+			std::exit(1);
+		}
+
+		pid_t pid = fork();
+		if (pid < 0) {
+			std::perror("fork");
+			std::exit(1);
+		} else if (pid == 0) {
+			dup2(to_child[0], STDIN_FILENO);
+			dup2(from_child[1], STDOUT_FILENO);
+			close(to_child[0]); close(to_child[1]);
+			close(from_child[0]); close(from_child[1]);
+
+			execl(path, path, "--seed=1", "6", "6", static_cast<char *>(nullptr));
+			std::perror(path);
+			_exit(1);
+		}
+
+		close(to_child[0]);
+		close(from_child[1]);
+		return {pid, to_child[1], from_child[0]};
+	}
+
+	/// Read from `fd` until the prompt ">>> " is at the end of the output.
+	///
+	/// @returns false if the program stopped writing first.
+	bool read_until_prompt(int fd)
+	{
+		constexpr std::string_view prompt{">>> "};
+		char buf[4096];
+		std::string tail;
+
+		for (;;) {
+			auto n = read(fd, buf, sizeof buf);
+			if (n <= 0) return false;
+
+			tail.append(buf, static_cast<std::size_t>(n));
+			if (tail.size() >= prompt.size()
+			    && std::string_view{tail}.substr(tail.size() - prompt.size()) == prompt) {
+				return true;
+			}
+			if (tail.size() > prompt.size()) tail.erase(0, tail.size() - prompt.size());
+		}
+	}
+
+	/// Write all of `str` to `fd`.
+	void write_all(int fd, std::string_view str)
+	{
+		while (!str.empty()) {
+			auto n = write(fd, str.data(), str.size());
+			if (n <= 0) {
+				std::perror("write");
+				std::exit(1);
+			}
+			str.remove_prefix(static_cast<std::size_t>(n));
+		}
+	}
+
+	/// The value below which `fraction` of the sorted `times` lie.
+	double percentile(std::vector<double> const& times, double fraction)
+	{
+		auto i = static_cast<std::size_t>(fraction * (times.size() - 1));
+		return times[i];
+	}
+}
+
+int main(int arg_c, char const* arg_v[])
+{
+	if (arg_c < 2) {
+		std::cerr << "Usage: " << arg_v[0] << " <path-to-dice> [<number-of-commands>]\n";
+		return 1;
+	}
+
+	long num_commands = (arg_c > 2) ? std::atol(arg_v[2]) : 100000;
+	if (num_commands <= 0) {
+		std::cerr << "Expected one or more commands.\n";
+		return 1;
+	}
+
+	// A mix of commands: mostly plain rolls, with a new choice of dice every
+	// fourth command.
+
+	constexpr std::string_view roll{"\n"};
+	constexpr std::string_view choose{"choose 6 6 20\n"};
+
+	auto c = spawn(arg_v[1]);
+	if (!read_until_prompt(c.out)) {
+		std::cerr << arg_v[1] << " exited before printing a prompt.\n";
+		return 1;
+	}
+
+	std::vector<double> times;
+	times.reserve(static_cast<std::size_t>(num_commands));
+
+	auto start = clock_type::now();
+
+	for (long i = 0; i < num_commands; ++i) {
+		auto t0 = clock_type::now();
+		write_all(c.in, (i % 4 == 0) ? choose : roll);
+		if (!read_until_prompt(c.out)) {
+			std::cerr << arg_v[1] << " exited unexpectedly.\n";
+			return 1;
+		}
+		auto t1 = clock_type::now();
+
+		times.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+	}
+
+	auto total = std::chrono::duration<double>(clock_type::now() - start).count();
+
+	write_all(c.in, "quit\n");
+	close(c.in);
+	close(c.out);
+	waitpid(c.pid, nullptr, 0);
+
+	std::sort(times.begin(), times.end());
+
+	std::cout << "commands: " << num_commands << "\n"
+	          << "p50:      " << percentile(times, 0.50) << " us\n"
+	          << "p99:      " << percentile(times, 0.99) << " us\n"
+	          << "max:      " << times.back() << " us\n"
+	          << "rate:     " << num_commands / total << " commands/s\n";
+}
@@ -0,0 +1,108 @@
+#ifndef DICE_ALIAS_TABLE
+#define DICE_ALIAS_TABLE
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "random.hpp"
+
+namespace dice {
+	/// A table for sampling indices from a discrete distribution in constant
+	/// time, using Vose's alias method.
+	///
+	/// The table is built with integer arithmetic, so every index is sampled
+	/// with exactly the probability given by its weight.
+	struct alias_table {
+		/// The type of the indices returned when sampling from the table.
+		using size_type = std::size_t;
+		
+		/// The type used to represent the weight of an index.
+		using weight_type = std::uint64_t;
+		
+		/// Construct an empty table, which cannot be sampled from.
+		///
+		/// This does not allocate any memory.
+		alias_table() = default;
+		
+		/// Construct a table where index `i` is sampled with probability
+		/// proportional to `weights[i]`.
+		///
+		/// @pre `weights` must be non-empty, and each weight must be greater
+		/// than zero.
+		/// @pre `weights.size()` multiplied by the sum of the weights must
+		/// be representable as a `weight_type`.
+		explicit alias_table(std::vector<weight_type> const& weights)
+		: thresholds(weights.size()),
+		  aliases(weights.size())
+		{
+			assert(!weights.empty());
+			
+			auto n = weights.size();
+			
+			total = 0;
+			for (auto w : weights) {
+				assert(w > 0);
+				total += w;
+			}
+			
+			assert(total <= std::numeric_limits<weight_type>::max() / n);
+			
+			// Each column of the table has capacity `total`. Scale the
+			// weights so that they sum to `n * total`, then repeatedly pair
+			// an under-full column with an over-full one.
+			
+			std::vector<weight_type> scaled;
+			std::vector<size_type> small, large;
+			
+			for (size_type i = 0; i < n; ++i) {
+				scaled.push_back(weights[i] * n);
+				(scaled[i] < total ? small : large).push_back(i);
+			}
+			
+			while (!small.empty() && !large.empty()) {
+				auto l = small.back(); small.pop_back();
+				auto g = large.back(); large.pop_back();
+				
+				thresholds[l] = scaled[l];
+				aliases[l] = g;
+				
+				scaled[g] = (scaled[g] + scaled[l]) - total;
+				(scaled[g] < total ? small : large).push_back(g);
+			}
+			
+			for (auto i : large) { thresholds[i] = total; aliases[i] = i; }
+			for (auto i : small) { thresholds[i] = total; aliases[i] = i; }
+			
+			range = n * total;
+		}
+		
+		/// The number of indices in the table.
+		size_type size() const { return thresholds.size(); }
+		
+		/// Sample an index using `eng`.
+		///
+		/// @pre The table must not be empty.
+		///
+		/// A single value is drawn from `eng` and split into a column and an
+		/// offset within that column, so the cost does not depend on the
+		/// size of the table.
+		template <typename Engine>
+		size_type operator() (Engine & eng) const
+		{
+			auto u = uniform_below(eng, range);
+			auto i = static_cast<size_type>(u / total);
+			return (u % total < thresholds[i]) ? i : aliases[i];
+		}
+		
+	private:
+		weight_type total{1};
+		std::vector<weight_type> thresholds;
+		std::vector<size_type> aliases;
+		weight_type range{1};
+	};
+}
+
+#endif
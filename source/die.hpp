@@ -1,8 +1,13 @@
 #ifndef DICE_DIE
 #define DICE_DIE
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
+#include "alias_table.hpp"
 #include "random.hpp"
 
 namespace dice {
@@ -10,6 +15,9 @@ namespace dice {
 		/// The type of value returned when the die is rolled.
 		using result_type = int;
 		
+		/// The type used to represent the weight of a face.
+		using weight_type = alias_table::weight_type;
+		
 		/// Construct a six-sided die.
 		die() = default;
 		
@@ -17,19 +25,82 @@ namespace dice {
 		///
 		/// @pre `n` must be greater than zero.
 		die(result_type n)
-		: dist{1, n}
+		: num_sides{n}
 		{ 
 			assert(n > 0);
 		}
 		 
+		/// Construct a die whose faces show the values in `faces`, where
+		/// `faces[i]` is rolled with probability proportional to
+		/// `weights[i]`.
+		///
+		/// @pre `faces` must be non-empty, and `faces.size()` and
+		/// `weights.size()` must be equal.
+		/// @pre The weights must satisfy the preconditions of `alias_table`.
+		die(std::vector<result_type> faces, std::vector<weight_type> weights)
+		: custom_faces{std::move(faces)},
+		  custom_weights{std::move(weights)},
+		  table{custom_weights}
+		{
+			assert(!custom_faces.empty());
+			assert(custom_faces.size() == custom_weights.size());
+			
+			auto [lo, hi] = std::minmax_element(custom_faces.begin(), custom_faces.end());
+			custom_min = *lo;
+			custom_max = *hi;
+		}
+		
+		/// Whether the die has faces 1 to `sides()`, each with equal
+		/// probability.
+		bool is_standard() const { return custom_faces.empty(); }
+		
 		/// The number of sides that the die has.
-		result_type sides() const { return dist.max(); }
+		result_type sides() const
+		{
+			return is_standard() ? num_sides : static_cast<result_type>(custom_faces.size());
+		}
+		
+		/// The smallest value that can be rolled.
+		result_type min() const
+		{
+			return is_standard() ? 1 : custom_min;
+		}
 		
-		/// Roll the die.
-		result_type operator() () const { return dist(rand_eng); }
+		/// The largest value that can be rolled.
+		result_type max() const
+		{
+			return is_standard() ? num_sides : custom_max;
+		}
+		
+		/// The values shown on the faces of a non-standard die.
+		///
+		/// @pre `is_standard()` must be false.
+		std::vector<result_type> const& faces() const { return custom_faces; }
+		
+		/// The weights of the faces of a non-standard die.
+		///
+		/// @pre `is_standard()` must be false.
+		std::vector<weight_type> const& weights() const { return custom_weights; }
+		
+		/// Roll the die using `rand_eng`.
+		result_type operator() () const { return (*this)(rand_eng); }
+		
+		/// Roll the die using `eng`.
+		///
+		/// @pre `eng` must satisfy the preconditions of `uniform_below`.
+		template <typename Engine>
+		result_type operator() (Engine & eng) const
+		{
+			if (!is_standard()) return custom_faces[table(eng)];
+			return static_cast<result_type>(1 + uniform_below(eng, static_cast<std::uint64_t>(num_sides)));
+		}
 		
 	private:
-		mutable std::uniform_int_distribution<result_type> dist{1, 6};
+		result_type num_sides{6};
+		std::vector<result_type> custom_faces;
+		std::vector<weight_type> custom_weights;
+		result_type custom_min{0}, custom_max{0};
+		alias_table table;
 	};
 }
 
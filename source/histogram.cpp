@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include "util/string.hpp"
+
+#include "histogram.hpp"
+
+using namespace dice;
+
+namespace {
+	/// The first line of every histogram file.
+	constexpr std::string_view magic_line{"dice-histogram 2"};
+
+	/// Convert all of `str` to an integer and store it in `value`.
+	bool read_integer(std::string_view str, long long & value)
+	{
+		return util::from_chars(str, value).ec == std::errc{};
+	}
+}
+
+void dice::write_histogram(std::ostream & out, histogram const& h)
+{
+	out << magic_line << "\n"
+	    << "version " << h.version << "\n"
+	    << "seed " << h.seed << "\n"
+	    << "dice " << h.dice << "\n"
+	    << "rows " << h.rows.begin << " " << h.rows.end << " " << h.total_rows << "\n";
+
+	for (auto [sum, count] : h.counts) {
+		out << sum << " " << count << "\n";
+	}
+}
+
+std::optional<histogram> dice::read_histogram(std::istream & in, std::string_view name)
+{
+	histogram h;
+	std::string line;
+	std::vector<std::string_view> fields;
+
+	auto fail = [&](char const* what) {
+		std::cerr << name << ": " << what << ".\n";
+		return std::nullopt;
+	};
+
+	if (!std::getline(in, line) || line != magic_line) {
+		return fail("not a histogram file");
+	}
+
+	if (!std::getline(in, line) || line.rfind("version ", 0) != 0) {
+		return fail("missing version");
+	}
+	h.version = line.substr(8);
+
+	if (!std::getline(in, line) || line.rfind("seed ", 0) != 0
+	    || util::from_chars(std::string_view{line}.substr(5), h.seed).ec != std::errc{}) {
+		return fail("missing or invalid seed");
+	}
+
+	if (!std::getline(in, line) || line.rfind("dice ", 0) != 0) {
+		return fail("missing list of dice");
+	}
+	h.dice = line.substr(5);
+
+	if (!std::getline(in, line) || line.rfind("rows ", 0) != 0) {
+		return fail("missing range of rows");
+	}
+
+	util::split_and_prune(std::string_view{line}.substr(5), fields);
+	if (fields.size() != 3
+	    || !read_integer(fields[0], h.rows.begin)
+	    || !read_integer(fields[1], h.rows.end)
+	    || !read_integer(fields[2], h.total_rows)
+	    || h.rows.begin < 0 || h.rows.begin > h.rows.end || h.rows.end > h.total_rows) {
+		return fail("invalid range of rows");
+	}
+
+	// Every row contributes to exactly one sum, so the counts must add up
+	// to the number of rows. Anything else means that the file has been
+	// truncated or altered.
+
+	long long num_rows = 0;
+
+	while (std::getline(in, line)) {
+		long long sum, count;
+
+		util::split_and_prune(line, fields);
+		if (fields.size() != 2 || !read_integer(fields[0], sum) || !read_integer(fields[1], count)
+		    || count <= 0 || count > h.rows.end - h.rows.begin - num_rows) {
+			return fail("invalid count");
+		}
+
+		if (!h.counts.emplace(sum, count).second) {
+			return fail("a sum is listed more than once");
+		}
+		num_rows += count;
+	}
+
+	if (num_rows != h.rows.end - h.rows.begin) {
+		return fail("counts do not add up to the number of rows (the file may be truncated)");
+	}
+
+	return h;
+}
+
+std::optional<histogram> dice::merge_histograms(std::vector<histogram> parts)
+{
+	if (parts.empty()) {
+		std::cerr << "Expected one or more histograms to merge.\n";
+		return std::nullopt;
+	}
+
+	std::sort(parts.begin(), parts.end(), [](auto const& a, auto const& b) {
+		return std::pair{a.rows.begin, a.rows.end} < std::pair{b.rows.begin, b.rows.end};
+	});
+
+	histogram merged;
+	merged.version = parts.front().version;
+	merged.seed = parts.front().seed;
+	merged.dice = parts.front().dice;
+	merged.total_rows = parts.front().total_rows;
+
+	for (auto const& part : parts) {
+		if (part.version != merged.version) {
+			std::cerr << "Histograms were written by different versions of the program ("
+			          << merged.version << " and " << part.version << "), which may roll differently.\n";
+			return std::nullopt;
+		} else if (part.seed != merged.seed || part.dice != merged.dice || part.total_rows != merged.total_rows) {
+			std::cerr << "Histograms come from different runs (different seeds, dice or numbers of rolls).\n";
+			return std::nullopt;
+		} else if (part.rows.begin != merged.rows.end) {
+			std::cerr << "Histograms do not cover each row exactly once (expected row "
+			          << merged.rows.end << ", got row " << part.rows.begin << ").\n";
+			return std::nullopt;
+		}
+
+		merged.rows.end = part.rows.end;
+		for (auto [sum, count] : part.counts) merged.counts[sum] += count;
+	}
+
+	if (merged.rows.end != merged.total_rows) {
+		std::cerr << "Histograms do not cover each row exactly once (rows "
+		          << merged.rows.end << " to " << merged.total_rows << " are missing).\n";
+		return std::nullopt;
+	}
+
+	return merged;
+}
@@ -0,0 +1,93 @@
+#ifndef DICE_HISTOGRAM
+#define DICE_HISTOGRAM
+
+#include <istream>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "random.hpp"
+
+namespace dice {
+	/// One of several independent processes that together perform a run.
+	struct shard {
+		/// The position of this shard, from 1 to `count`.
+		int index{1};
+
+		/// The total number of shards.
+		int count{1};
+	};
+
+	/// The rows of a run that are rolled by a particular shard.
+	///
+	/// Row `r` is always rolled from substream `r` of the random engine, so
+	/// a shard produces exactly the same rolls for its rows as a single
+	/// process would.
+	struct row_range {
+		long long begin{0};
+		long long end{0};
+	};
+
+	/// Compute the rows that are rolled by shard `s` of a run with `num_rolls`
+	/// rows in total.
+	///
+	/// The ranges for shards 1 to `s.count` are contiguous and disjoint, and
+	/// together cover every row.
+	///
+	/// @pre `num_rolls` must be between 0 and
+	/// `counter_engine::num_substreams`, so that the products below cannot
+	/// overflow.
+	inline row_range shard_rows(shard s, long long num_rolls)
+	{
+		return {num_rolls * (s.index - 1) / s.count, num_rolls * s.index / s.count};
+	}
+
+	/// A histogram of the sums of the dice rolls over some range of rows.
+	struct histogram {
+		/// The version of the program that rolled the dice. The rolls for a
+		/// given seed are only guaranteed to match within the same version.
+		std::string version;
+
+		/// The seed used for the random engine.
+		seed_type seed{0};
+
+		/// The dice that were rolled, as written by `operator<<`.
+		std::string dice;
+
+		/// The rows that were rolled.
+		row_range rows;
+
+		/// The total number of rows in the run.
+		long long total_rows{0};
+
+		/// The number of rows with each sum. Sums with no rows are omitted.
+		std::map<long long, long long> counts;
+	};
+
+	/// Write `h` to `out` in a compact text format that can be read back by
+	/// `read_histogram`.
+	void write_histogram(std::ostream & out, histogram const& h);
+
+	/// Read a histogram from `in`. An error message mentioning `name` is
+	/// printed if the histogram is malformed.
+	///
+	/// @returns An optional containing the histogram, or `std::nullopt` if
+	/// the histogram could not be read.
+	std::optional<histogram> read_histogram(std::istream & in, std::string_view name);
+
+	/// Combine the partial histograms in `parts` into a histogram of the
+	/// whole run. An error message is printed if the parts do not come from
+	/// the same run, or do not cover each row exactly once.
+	///
+	/// The result is identical to the histogram produced by a single process
+	/// with the same seed and dice.
+	///
+	/// @returns An optional containing the merged histogram, or
+	/// `std::nullopt` if the parts cannot be merged.
+	std::optional<histogram> merge_histograms(std::vector<histogram> parts);
+}
+
+#endif
@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
 #include <limits>
+#include <numeric>
 
 #include "util/math.hpp"
 #include "util/numeric.hpp"
@@ -12,8 +15,84 @@ using int_limits = std::numeric_limits<int>;
 
 using namespace dice;
 
+namespace {
+	/// Read a die from a list of faces in the form "[f1,f2,...]".
+	std::optional<die> read_custom_die(std::string_view str)
+	{
+		std::vector<die::result_type> faces;
+		std::vector<die::weight_type> weights;
+
+		auto list = str.substr(1, str.size() - 2);
+
+		if (list.empty()) {
+			std::cerr << "Expected one or more faces, got " << str << ".\n";
+			return std::nullopt;
+		}
+
+		for (std::string_view::size_type i = 0; i <= list.size(); ) {
+			auto j = std::min(list.find(',', i), list.size());
+			auto item = list.substr(i, j - i);
+			i = j + 1;
+
+			auto colon = item.find(':');
+			auto face_str = item.substr(0, colon);
+
+			int face;
+			auto result = util::from_chars(face_str, face);
+
+			if (result.ec == std::errc::invalid_argument) {
+				std::cerr << "'" << face_str << "' is not an integer.\n";
+				return std::nullopt;
+			} else if (result.ec == std::errc::result_out_of_range) {
+				std::cerr << face_str << " is out of range for a face. Faces must be between " << int_limits::min() << " and " << int_limits::max() << ".\n";
+				return std::nullopt;
+			}
+
+			int weight = 1;
+
+			if (colon != std::string_view::npos) {
+				auto weight_str = item.substr(colon + 1);
+				result = util::from_chars(weight_str, weight);
+
+				if (result.ec == std::errc::invalid_argument) {
+					std::cerr << "'" << weight_str << "' is not an integer.\n";
+					return std::nullopt;
+				} else if (result.ec == std::errc::result_out_of_range) {
+					std::cerr << weight_str << " is too large for a weight. Maximum weight is " << int_limits::max() << ".\n";
+					return std::nullopt;
+				} else if (weight <= 0) {
+					std::cerr << "Expected a positive weight, got " << weight << ".\n";
+					return std::nullopt;
+				}
+			}
+
+			faces.push_back(face);
+			weights.push_back(static_cast<die::weight_type>(weight));
+		}
+
+		// The alias table needs the number of faces multiplied by the total
+		// weight to fit in a weight_type. This only fails for absurdly long
+		// lists, but check anyway.
+
+		using weight_limits = std::numeric_limits<die::weight_type>;
+		auto total = util::sum(weights);
+		if (faces.size() > static_cast<std::size_t>(int_limits::max()) || total > weight_limits::max() / faces.size()) {
+			std::cerr << "Too many faces for a die.\n";
+			return std::nullopt;
+		}
+
+		return die{std::move(faces), std::move(weights)};
+	}
+}
+
 std::optional<die> dice::read_die(std::string_view str)
 {
+	if (str.size() >= 2 && str.front() == 'd') str.remove_prefix(1);
+
+	if (str.size() >= 2 && str.front() == '[' && str.back() == ']') {
+		return read_custom_die(str);
+	}
+
 	std::optional<die> d;
 
 	int sides;
@@ -32,17 +111,19 @@ std::optional<die> dice::read_die(std::string_view str)
 	return d;
 }
 
-std::optional<int> dice::read_num_rolls(std::string_view str)
+std::optional<long long> dice::read_num_rolls(std::string_view str)
 {
-	std::optional<int> num_rolls;
+	std::optional<long long> num_rolls;
+
+	constexpr long long max_rolls = counter_engine::num_substreams;
 
-	int i;
+	long long i;
 	auto result = util::from_chars(str, i);
 
 	if (result.ec == std::errc::invalid_argument) {
 		std::cerr << "'" << str << "' is not an integer.\n";
-	} else if (result.ec == std::errc::result_out_of_range) {
-		std::cerr << "Maximum number of rolls is " << int_limits::max() << ".\n";
+	} else if (result.ec == std::errc::result_out_of_range || i > max_rolls) {
+		std::cerr << "Maximum number of rolls is " << max_rolls << ".\n";
 	} else if (i < 0) {
 		std::cerr << "Expected zero or more rolls, got " << i << ".\n";
 	} else {
@@ -52,6 +133,63 @@ std::optional<int> dice::read_num_rolls(std::string_view str)
 	return num_rolls;
 }
 
+std::optional<seed_type> dice::read_seed(std::string_view str)
+{
+	std::optional<seed_type> seed;
+
+	seed_type value;
+	auto result = util::from_chars(str, value);
+
+	if (result.ec == std::errc::invalid_argument) {
+		std::cerr << "'" << str << "' is not a non-negative integer.\n";
+	} else if (result.ec == std::errc::result_out_of_range) {
+		std::cerr << "Maximum seed is " << std::numeric_limits<seed_type>::max() << ".\n";
+	} else {
+		seed = value;
+	}
+
+	return seed;
+}
+
+std::optional<shard> dice::read_shard(std::string_view str)
+{
+	auto slash = str.find('/');
+	if (slash == std::string_view::npos) {
+		std::cerr << "'" << str << "' is not in the form i/n.\n";
+		return std::nullopt;
+	}
+
+	shard s;
+	auto index_str = str.substr(0, slash);
+	auto count_str = str.substr(slash + 1);
+
+	if (util::from_chars(index_str, s.index).ec != std::errc{}
+	    || util::from_chars(count_str, s.count).ec != std::errc{}) {
+		std::cerr << "'" << str << "' is not in the form i/n, where i and n are integers.\n";
+		return std::nullopt;
+	} else if (s.count <= 0) {
+		std::cerr << "Expected one or more shards, got " << s.count << ".\n";
+		return std::nullopt;
+	} else if (s.index <= 0 || s.index > s.count) {
+		std::cerr << "Expected a shard between 1 and " << s.count << ", got " << s.index << ".\n";
+		return std::nullopt;
+	}
+
+	return s;
+}
+
+std::ostream & dice::operator<< (std::ostream & out, die const& d) {
+	if (d.is_standard()) return out << 'd' << d.sides();
+
+	out << "d[";
+	for (std::vector<die::result_type>::size_type i = 0; i < d.faces().size(); ++i) {
+		if (i != 0) out << ',';
+		out << d.faces()[i];
+		if (d.weights()[i] != 1) out << ':' << d.weights()[i];
+	}
+	return out << ']';
+}
+
 std::ostream & dice::operator<< (std::ostream & out, std::vector<die> const& dice) {
 	if (dice.empty()) return out;
 
@@ -63,25 +201,22 @@ std::ostream & dice::operator<< (std::ostream & out, std::vector<die> const& dic
 }
 
 void dice::write_die_roll(std::ostream & out, die const& d, die::result_type roll) {
-	auto max_roll = d.sides();
-	
-	auto str = std::to_string(roll);
-	auto len = util::num_digits(max_roll);
-	util::pad_front(str, ' ', len);
+	auto len = std::max(util::num_chars(d.min()), util::num_chars(d.max()));
 	
-	out << str;
+	out << std::setw(len) << roll;
 }
 
 void dice::write_dice_roll_sum(std::ostream & out, std::vector<die> const& dice, std::vector<die::result_type> const& rolls) {
-	auto sum = util::sum(rolls);
-	die::result_type max_sum = 0;
-	for (auto & d: dice) max_sum += d.sides();
+	auto sum = std::accumulate(rolls.begin(), rolls.end(), 0LL);
+	long long min_sum = 0, max_sum = 0;
+	for (auto & d: dice) {
+		min_sum += d.min();
+		max_sum += d.max();
+	}
 	
-	auto str = std::to_string(sum);
-	auto len = util::num_digits(max_sum);
-	util::pad_front(str, ' ', len);
+	auto len = std::max(util::num_chars(min_sum), util::num_chars(max_sum));
 	
-	out << str;
+	out << std::setw(len) << sum;
 }
 
 void dice::print_chosen_dice(std::vector<die> const& dice) {
@@ -142,6 +277,8 @@ void dice::print_program_help() {
 	std::cout << "Press ENTER with a blank input to roll the dice.\n"
 	          << "Enter 'choose <n1> <n2> ...' to choose a new set of dice to roll,\n"
 	          << "  where <n1>, <n2>, ... are the number of sides on the dice.\n"
+	          << "  A die can also be given as a list of faces '[f1,f2,...]', where\n"
+	          << "  each face may have a weight, e.g. '[-1,0,1]' or '[1,2,3,4,5,6:2]'.\n"
 	          << "Enter 'list' to print the chosen dice.\n"
 	          << "Enter 'help' or '?' to print this help message.\n"
 	          << "Enter 'quit' or 'exit' to quit the program.\n";
@@ -153,7 +290,10 @@ void dice::print_invalid_input() {
 }
 
 void dice::print_cl_help(std::string_view basename) {
-	std::cout << "Usage: " << basename << " <options> [<number-of-sides> ...]\n"
+	std::cout << "Usage: " << basename << " <options> [<die> ...]\n"
+	          << "\n"
+	          << "Each <die> is either a number of sides, or a list of faces\n"
+	          << "[<f1>,<f2>,...] where each face may be followed by :<weight>.\n"
 	          << "\n"
 	          << "Options:\n"
 	          << "  [-? | --help]         Print this help message, then quit.\n"
@@ -162,11 +302,28 @@ void dice::print_cl_help(std::string_view basename) {
 	          << "  [-v | --verbose]      Show the totals of the rolls and other information\n"
 	          << "                        (default).\n"
 	          << "  [--rolls=<N>]         Roll the dice <N> times, then quit.\n"
+	          << "  [--seed=<S>]          Seed the random engine with <S>, so that the same\n"
+	          << "                        rolls are produced on every run.\n"
+	          << "  [--histogram]         With --rolls, print a histogram of the sums of the\n"
+	          << "                        rolls instead of each roll.\n"
+	          << "  [--shard=<i>/<n>]     With --rolls and --seed, roll only the i-th of n\n"
+	          << "                        equal parts of the rolls and print their histogram.\n"
+	          << "  [--merge <file> ...]  Combine histograms from every shard of a run into\n"
+	          << "                        the histogram of the whole run, then quit.\n"
 	          << "\n"
 	          << "Examples:\n"
 	          << "  " << basename << "                  Start with a d6.\n"
 	          << "  " << basename << " 6 6              Start with two d6's.\n"
-	          << "  " << basename << " 20               Start with a d20.\n";
+	          << "  " << basename << " 20               Start with a d20.\n"
+	          << "  " << basename << " '[-1,0,1]'       Start with a Fudge die.\n"
+	          << "  " << basename << " '[1,2,3:2]'      Start with a d3 that rolls 3 half the time.\n"
+	          << "\n"
+	          << "Sharded runs:\n"
+	          << "  " << basename << " --seed=7 --rolls=1000000 --shard=1/2 6 6 > part1\n"
+	          << "  " << basename << " --seed=7 --rolls=1000000 --shard=2/2 6 6 > part2\n"
+	          << "  " << basename << " --merge part1 part2\n"
+	          << "The merged histogram is identical to that of\n"
+	          << "  " << basename << " --seed=7 --rolls=1000000 --histogram 6 6\n";
 }
 
 void dice::print_version() {
@@ -9,16 +9,32 @@
 #include <vector>
 
 #include "die.hpp"
+#include "histogram.hpp"
 
 namespace dice {
 	namespace regex {
 		/// A regular expression to parse the number of dice rolls specified
 		/// at the command line.
 		inline auto const rolls_option = std::regex{"(?:--rolls=)(.*)"};
+		
+		/// A regular expression to parse the seed specified at the command
+		/// line.
+		inline auto const seed_option = std::regex{"(?:--seed=)(.*)"};
+		
+		/// A regular expression to parse the shard specified at the command
+		/// line.
+		inline auto const shard_option = std::regex{"(?:--shard=)(.*)"};
 	}
 	
-	/// Convert `str` to an integer and construct a die with this many sides.
-	/// An error message is printed if the die cannot be constructed.
+	/// Construct a die from `str`. An error message is printed if the die
+	/// cannot be constructed.
+	///
+	/// If `str` is an integer, the die has this many sides. Otherwise, `str`
+	/// should be a list of faces in the form "[f1,f2,...]", where each face
+	/// is an integer optionally followed by ":w" for some positive integer
+	/// weight w (1 by default). Each face is rolled with probability
+	/// proportional to its weight. Either form may be prefixed by 'd', as
+	/// written by `operator<<`.
 	///
 	/// @returns An optional containing the die, or `std::nullopt` if the die
 	/// cannot be constructed.
@@ -28,15 +44,32 @@ namespace dice {
 	/// roll the dice before quitting the program. An error message is printed
 	/// if the operation fails.
 	///
+	/// Each roll is made from its own substream of `rand_eng`, so the number
+	/// of rolls is limited to `counter_engine::num_substreams`.
+	///
 	/// @returns An optional containing the number of rolls, or `std::nullopt`
 	/// if the operation fails.
-	std::optional<int> read_num_rolls(std::string_view str);
+	std::optional<long long> read_num_rolls(std::string_view str);
+
+	/// Convert `str` to an unsigned integer and treat this as the seed for
+	/// the random engine. An error message is printed if the operation fails.
+	///
+	/// @returns An optional containing the seed, or `std::nullopt` if the
+	/// operation fails.
+	std::optional<seed_type> read_seed(std::string_view str);
+
+	/// Convert `str`, in the form "i/n", to the i-th of n shards. An error
+	/// message is printed if the operation fails.
+	///
+	/// @returns An optional containing the shard, or `std::nullopt` if the
+	/// operation fails.
+	std::optional<shard> read_shard(std::string_view str);
 
 	/// Write "dN" to `os`, where N is the number of sides of `d`.
-	inline std::ostream & operator<< (std::ostream & os, die const& d)
-	{
-		return os << 'd' << d.sides();
-	}
+	///
+	/// If `d` is not a standard die, "d[f1,f2,...]" is written instead,
+	/// using the same notation as `read_die`.
+	std::ostream & operator<< (std::ostream & os, die const& d);
 	
 	/// Write `dice` to `out` as a list in the form "dn1 dn2 ...".
 	std::ostream & operator<< (
@@ -46,8 +79,9 @@ namespace dice {
 	/// Write the die roll obtained from `d` to `out`.
 	///
 	/// Extra spaces are inserted at the front of the outputted text based on
-	/// the number of sides of `d`, so that the same number of characters will
-	/// be output regardless of which value `roll` takes.
+	/// the smallest and largest values that can be rolled on `d`, so that
+	/// the same number of characters will be output regardless of which
+	/// value `roll` takes.
 	///
 	/// `roll` should be a valid roll, i.e. obtainable by rolling `d`.
 	void write_die_roll(std::ostream & out, die const& d, die::result_type roll);
@@ -55,9 +89,9 @@ namespace dice {
 	/// Write the sum of the dice rolls to `out`.
 	///
 	/// Extra spaces are inserted at the front of the outputted text based on
-	/// the maximum possible sum that can be obtained by rolling the dice in
-	/// `dice`, so that the same number of characters will be output
-	/// regardless of the precise rolls that are passed in.
+	/// the minimum and maximum possible sums that can be obtained by rolling
+	/// the dice in `dice`, so that the same number of characters will be
+	/// output regardless of the precise rolls that are passed in.
 	///
 	/// Each `rolls[i]` should be obtainable by rolling `dice[i]`.
 	/// Furthermore, `dice.size()` and `rolls.size()` should be equal.
@@ -0,0 +1,75 @@
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "die.hpp"
+#include "info.hpp"
+#include "libdice.h"
+#include "random.hpp"
+#include "roll.hpp"
+
+using namespace dice;
+
+struct dice_pool {
+	std::vector<die> dice;
+	counter_engine eng;
+	std::uint64_t next_row{0};
+	mutable std::mutex mutex;
+};
+
+char const* dice_version(void)
+{
+	return version_c_str;
+}
+
+dice_pool * dice_pool_create(int const* sides, size_t count)
+{
+	// Exceptions must not escape into C code.
+
+	try {
+		auto pool = std::make_unique<dice_pool>();
+
+		for (size_t i = 0; i < count; ++i) {
+			if (sides[i] <= 0) return nullptr;
+			pool->dice.emplace_back(sides[i]);
+		}
+
+		pool->eng.seed(random_seed());
+		return pool.release();
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void dice_pool_destroy(dice_pool * pool)
+{
+	delete pool;
+}
+
+size_t dice_pool_size(dice_pool const* pool)
+{
+	return pool->dice.size();
+}
+
+void dice_pool_seed(dice_pool * pool, uint64_t seed)
+{
+	std::lock_guard lock{pool->mutex};
+	pool->eng.seed(seed);
+	pool->next_row = 0;
+}
+
+int dice_pool_roll(dice_pool * pool, size_t rows, int * out)
+{
+	std::lock_guard lock{pool->mutex};
+
+	// Rolling past the last substream would repeat earlier rows.
+	if (rows > DICE_POOL_MAX_ROWS - pool->next_row) return -1;
+
+	for (size_t r = 0; r < rows; ++r) {
+		roll_row(pool->dice, pool->eng, pool->next_row++, out);
+		out += pool->dice.size();
+	}
+
+	return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef DICE_LIBDICE_H
+#define DICE_LIBDICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DICE_API __attribute__((visibility("default")))
+#else
+#define DICE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// A set of dice together with a random engine used to roll them.
+///
+/// Each pool has its own engine, and may be used from several threads at
+/// once. After `dice_pool_seed(pool, S)`, the rows rolled are identical to
+/// those printed by `dice --seed=S --rolls=N -q <sides> ...`.
+typedef struct dice_pool dice_pool;
+
+/// The maximum number of rows that a pool can roll after being created or
+/// seeded. Each row uses its own substream of the pool's engine, and there
+/// are no more substreams beyond this.
+#define DICE_POOL_MAX_ROWS ((uint64_t)1 << 32)
+
+/// The version of the library, e.g. "0.3.1".
+DICE_API char const* dice_version(void);
+
+/// Create a pool of `count` dice, where die `i` has `sides[i]` sides. The
+/// pool is seeded from a random device.
+///
+/// @returns The new pool, or NULL if some `sides[i]` is not greater than
+/// zero or memory could not be allocated. The pool must be released with
+/// `dice_pool_destroy`.
+DICE_API dice_pool * dice_pool_create(int const* sides, size_t count);
+
+/// Release `pool` and all of its resources. Does nothing if `pool` is NULL.
+DICE_API void dice_pool_destroy(dice_pool * pool);
+
+/// The number of dice in `pool`.
+DICE_API size_t dice_pool_size(dice_pool const* pool);
+
+/// Seed the engine of `pool` with `seed`, and restart from row 0.
+DICE_API void dice_pool_seed(dice_pool * pool, uint64_t seed);
+
+/// Roll the dice in `pool` for the next `rows` rows, writing the rolls to
+/// `out` in row-major order.
+///
+/// Row `r` is rolled from its own substream of the engine, and successive
+/// calls continue from the row after the last one rolled.
+///
+/// `out` must have room for `rows * dice_pool_size(pool)` values.
+///
+/// @returns 0 on success, or -1 if this would take the pool past
+/// `DICE_POOL_MAX_ROWS` rows since it was created or last seeded. In that
+/// case nothing is written, and the pool must be seeded again before it
+/// can roll any more rows.
+DICE_API int dice_pool_roll(dice_pool * pool, size_t rows, int * out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
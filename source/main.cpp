@@ -1,5 +1,7 @@
+#include <fstream>
 #include <iostream>
 #include <optional>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -10,35 +12,100 @@
 #include "util/string.hpp"
 
 #include "die.hpp"
+#include "histogram.hpp"
+#include "info.hpp"
 #include "io.hpp"
+#include "roll.hpp"
 
 using optional_int = std::optional<int>;
 
 using namespace dice;
 
-/// Roll each of the given dice.
+/// The settings chosen through command-line options.
+struct options {
+	std::optional<long long> num_rolls;
+	std::optional<seed_type> seed_value;
+	std::optional<shard> shard_value;
+	bool histogram = false;
+	bool merge = false;
+	bool verbose = true;
+};
+
+/// A command that can be entered in interactive mode.
+enum class command { roll, quit, help, list, choose, invalid };
+
+/// Buffers that are reused between commands in interactive mode, so that
+/// handling a command does not allocate memory once they are large enough.
+struct buffers {
+	std::string input;
+	std::vector<std::string_view> tokens;
+	std::vector<die> new_dice;
+	std::vector<die::result_type> rolls;
+};
+
+/// Roll each of the given dice and print the result, using `rolls` as
+/// storage for the rolls.
+void roll_dice_and_print(std::vector<die> const& dice, std::vector<die::result_type> & rolls, bool verbose)
+{
+	roll_dice(dice, rand_eng, rolls);
+	print_dice_roll(dice, rolls, verbose);
+}
+
+/// Roll the dice once for each row in `rows`, and print the result.
 ///
-/// @returns a vector containing each roll, in the same order as the
-/// corresponding dice.
-std::vector<die::result_type> roll_dice(std::vector<die> const& dice)
+/// Each row is rolled with `roll_row`, so the output matches that of the
+/// library for the same seed.
+void roll_rows_and_print(std::vector<die> const& dice, row_range rows, bool verbose)
 {
-	std::vector<die::result_type> roll;
-	for (auto & d : dice) roll.push_back(d());
-	return roll;
+	std::vector<die::result_type> rolls(dice.size());
+
+	for (auto r = rows.begin; r != rows.end; ++r) {
+		roll_row(dice, rand_eng, r, rolls.data());
+		print_dice_roll(dice, rolls, verbose);
+	}
 }
 
-/// Roll each of the given dice and print the result.
-void roll_dice_and_print(std::vector<die> const& dice, bool verbose)
+/// Read the histogram files named in `args`, and print their combination.
+/// Any options are ignored.
+///
+/// Returns the status code for the program.
+int merge_histogram_files(std::vector<std::string_view> const& args)
 {
-	auto roll = roll_dice(dice);
-	print_dice_roll(dice, roll, verbose);
+	std::vector<histogram> parts;
+
+	for (auto iter = args.begin() + 1; iter != args.end(); ++iter) {
+		std::string_view arg = *iter;
+
+		if (util::is_clo(arg)) continue;
+
+		std::ifstream file{std::string{arg}};
+		if (!file) {
+			std::cerr << arg << ": could not be opened.\n";
+			return 1;
+		}
+
+		std::optional<histogram> h = read_histogram(file, arg);
+		if (h) {
+			parts.push_back(std::move(*h));
+		} else {
+			return 1;
+		}
+	}
+
+	std::optional<histogram> merged = merge_histograms(std::move(parts));
+	if (merged) {
+		write_histogram(std::cout, *merged);
+		return 0;
+	} else {
+		return 1;
+	}
 }
 
 /// Apply the effects of the command line options. Any other input is ignored.
 /// 
 /// Optionally returns a status code. If present, the program should be
 /// terminated after this function is called.
-optional_int process_options(std::vector<std::string_view> const& args, optional_int & num_rolls, bool & verbose)
+optional_int process_options(std::vector<std::string_view> const& args, options & opts)
 {
 	std::string_view basename = args[0];
 
@@ -52,26 +119,65 @@ optional_int process_options(std::vector<std::string_view> const& args, optional
 			print_version();
 			return 0;
 		} else if (arg == "-q" || arg == "--quiet") {
-			verbose = false;
+			opts.verbose = false;
 		} else if (arg == "-v" || arg == "--verbose") {
-			verbose = true;
+			opts.verbose = true;
 		} else if (util::sv_match match; util::regex_match(arg, match, regex::rolls_option)) {
 			std::string_view str = util::as_string_view(match[1]);
 
-			std::optional<int> i = read_num_rolls(str);
+			std::optional<long long> i = read_num_rolls(str);
 			if (i) {
-				num_rolls = *i;
+				opts.num_rolls = *i;
+			} else {
+				std::cerr << "\n";
+				print_option_use_hint(arg, basename);
+				return 1;
+			}
+		} else if (util::sv_match match; util::regex_match(arg, match, regex::seed_option)) {
+			std::string_view str = util::as_string_view(match[1]);
+
+			std::optional<seed_type> s = read_seed(str);
+			if (s) {
+				opts.seed_value = *s;
+			} else {
+				std::cerr << "\n";
+				print_option_use_hint(arg, basename);
+				return 1;
+			}
+		} else if (util::sv_match match; util::regex_match(arg, match, regex::shard_option)) {
+			std::string_view str = util::as_string_view(match[1]);
+
+			std::optional<shard> s = read_shard(str);
+			if (s) {
+				opts.shard_value = *s;
 			} else {
 				std::cerr << "\n";
 				print_option_use_hint(arg, basename);
 				return 1;
 			}
+		} else if (arg == "--histogram") {
+			opts.histogram = true;
+		} else if (arg == "--merge") {
+			opts.merge = true;
 		} else if (util::is_clo(arg)) {
 			print_nonexistent_option_hint(arg, basename);
 			return 1;
 		}
 	}
 
+	if (opts.shard_value) opts.histogram = true;
+
+	if (opts.histogram && !opts.num_rolls) {
+		std::cerr << "--histogram and --shard can only be used together with --rolls.\n";
+		print_help_message_hint(basename);
+		return 1;
+	} else if (opts.shard_value && !opts.seed_value) {
+		std::cerr << "--shard can only be used together with --seed, so that every shard\n"
+		          << "uses the same random engine.\n";
+		print_help_message_hint(basename);
+		return 1;
+	}
+
 	return std::nullopt;
 }
 
@@ -101,58 +207,110 @@ optional_int process_choice_of_dice(std::vector<std::string_view> const& args, s
 	return std::nullopt;
 }
 
+/// Look up the command whose name is `name`.
+///
+/// The first character of each command's name is unique, so it is used as
+/// a perfect hash, and at most one full comparison is needed.
+command lookup_command(std::string_view name)
+{
+	if (name.empty()) return command::invalid;
+
+	switch (name.front()) {
+	case 'q': return name == "quit" ? command::quit : command::invalid;
+	case 'e': return name == "exit" ? command::quit : command::invalid;
+	case 'h': return name == "help" ? command::help : command::invalid;
+	case '?': return name == "?" ? command::help : command::invalid;
+	case 'l': return name == "list" ? command::list : command::invalid;
+	case 'c': return name == "choose" ? command::choose : command::invalid;
+	default: return command::invalid;
+	}
+}
+
 /// Process user input during interactive mode.
-void handle_input(std::string_view input, std::vector<die> & dice, bool & quit, bool verbose)
+///
+/// The input is tokenized in place, and `buf` is used for any other storage
+/// that is needed.
+void handle_input(std::string_view input, std::vector<die> & dice, buffers & buf, bool & quit, bool verbose)
 {
-	auto commands = util::split_and_prune(input);
-	
-	if (commands.empty()) {
-		roll_dice_and_print(dice, verbose);
-	} else if (commands[0] == "quit" || commands[0] == "exit") {
+	auto & tokens = buf.tokens;
+	util::split_and_prune(input, tokens);
+
+	auto cmd = tokens.empty() ? command::roll : lookup_command(tokens[0]);
+
+	switch (cmd) {
+	case command::roll:
+		roll_dice_and_print(dice, buf.rolls, verbose);
+		break;
+
+	case command::quit:
 		quit = true;
-	} else if (commands[0] == "help" || commands[0] == "?") {
+		break;
+
+	case command::help:
 		print_program_help();
-	} else if (commands[0] == "list") {
+		break;
+
+	case command::list:
 		print_chosen_dice(dice);
-	} else if (commands[0] == "choose") {
-		std::vector<die> new_dice;
-		
-		for (auto iter = commands.begin() + 1; iter != commands.end(); ++iter) {
-			std::string_view str = *iter;
+		break;
 
-			std::optional<die> d = read_die(str);
-			if (d) {
-				new_dice.push_back(std::move(*d));
-			} else {
-				return;
+	case command::choose:
+		{
+			auto & new_dice = buf.new_dice;
+			new_dice.clear();
+
+			for (auto iter = tokens.begin() + 1; iter != tokens.end(); ++iter) {
+				std::string_view str = *iter;
+
+				std::optional<die> d = read_die(str);
+				if (d) {
+					new_dice.push_back(std::move(*d));
+				} else {
+					return;
+				}
 			}
+
+			// Swap rather than move, so that the storage of the old dice is
+			// reused for the next choice.
+			dice.swap(new_dice);
+			roll_dice_and_print(dice, buf.rolls, verbose);
+			break;
 		}
-		
-		dice = std::move(new_dice);
-		roll_dice_and_print(dice, verbose);
-	} else {
+
+	case command::invalid:
 		print_invalid_input();
+		break;
 	}
 }
 
 int main(int arg_c, char const* arg_v[])
 {
 	std::vector<die> dice;
-	optional_int num_rolls;
-	bool verbose = true;
+	options opts;
+
+	// Nothing else in the program uses C stdio, so let the standard streams
+	// buffer independently of it.
+
+	std::ios::sync_with_stdio(false);
 
 	// Process input to the program.
 
 	auto args = util::encapsulate_args(arg_c, arg_v);
 
-	if (optional_int status = process_options(args, num_rolls, verbose); status) {
+	if (optional_int status = process_options(args, opts); status) {
 		return *status;
 	}
 
+	if (opts.merge) {
+		return merge_histogram_files(args);
+	}
+
 	if (optional_int status = process_choice_of_dice(args, dice); status) {
 		return *status;
 	}
 
+	bool verbose = opts.verbose && !opts.histogram;
+
 	// Choose a default set of dice if none were specified by the user.
 	
 	if (dice.empty()) {
@@ -160,21 +318,50 @@ int main(int arg_c, char const* arg_v[])
 		print_default_dice(dice, verbose);
 	}
 
-	// Set a seed for the random engine.
+	// Set a seed for the random engine, either as requested by the user or
+	// from a random device. A histogram records its seed, so always choose
+	// one explicitly in that case.
 	
-	seed();
+	if (opts.histogram && !opts.seed_value) {
+		opts.seed_value = random_seed();
+	}
+
+	if (opts.seed_value) {
+		seed(*opts.seed_value);
+	} else {
+		seed();
+	}
 
 	// Either roll the dice the requested number of times and immediately quit,
 	// or roll the dice once and wait for further input.
 	
-	if (num_rolls) {
-		for (int i = 0; i < *num_rolls; ++i) roll_dice_and_print(dice, verbose);
+	if (opts.num_rolls) {
+		auto rows = shard_rows(opts.shard_value.value_or(shard{}), *opts.num_rolls);
+
+		if (opts.histogram) {
+			histogram h = roll_histogram(dice, rand_eng, rows);
+			std::ostringstream ss;
+			ss << dice;
+			h.dice = ss.str();
+			h.version = version_c_str;
+			h.seed = *opts.seed_value;
+			h.total_rows = *opts.num_rolls;
+			write_histogram(std::cout, h);
+		} else {
+			roll_rows_and_print(dice, rows, verbose);
+		}
+
 		return 0;
-	} else {
-		roll_dice_and_print(dice, verbose);
 	}
 
+	buffers buf;
+	roll_dice_and_print(dice, buf.rolls, verbose);
+
 	// The main loop ...
+	//
+	// The prompt is only buffered here. Since std::cin is tied to std::cout,
+	// it is flushed together with the output of the previous command when
+	// the next line is read, so each command costs a single write.
 	
 	for (bool quit = false; !quit; ) {
 		std::cout << ">>> ";
@@ -183,8 +370,8 @@ int main(int arg_c, char const* arg_v[])
 		// Stop program execution when the input becomes invalid (e.g., EOF is
 		// encountered).
 		
-		if (std::string input; std::getline(std::cin, input)) {
-			handle_input(input, dice, quit, verbose);
+		if (std::getline(std::cin, buf.input)) {
+			handle_input(buf.input, dice, buf, quit, verbose);
 		} else {
 			std::cout << std::endl;
 			quit = true;
@@ -1,18 +1,152 @@
 #ifndef DICE_RANDOM
 #define DICE_RANDOM
 
+#include <cassert>
+#include <cstdint>
+#include <limits>
 #include <random>
 
 namespace dice {
-	/// A `mt19937` used as the random number engine when rolling dice.
+	/// A counter-based random number engine.
+	///
+	/// The n-th value produced is a bijective mix of the key and n, so the
+	/// engine can be moved to any position in constant time. In particular,
+	/// the engine is divided into substreams of `substream_length` values
+	/// each, and two substreams with the same key never share a value of
+	/// the counter.
+	struct counter_engine {
+		/// The type of value produced by the engine.
+		using result_type = std::uint64_t;
+
+		/// The number of values in each substream.
+		static constexpr std::uint64_t substream_length = std::uint64_t{1} << 32;
+
+		/// The number of substreams, so that together they cover every value
+		/// of the counter exactly once.
+		static constexpr std::uint64_t num_substreams = std::uint64_t{1} << 32;
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+		/// Construct an engine with key 0, positioned at the start of
+		/// substream 0.
+		counter_engine() = default;
+
+		/// Construct an engine with the given key, positioned at the start of
+		/// substream 0.
+		explicit counter_engine(std::uint64_t key) { seed(key); }
+
+		/// Set the key of the engine, and move to the start of substream 0.
+		void seed(std::uint64_t key)
+		{
+			this->key = mix(key);
+			counter = 0;
+		}
+
+		/// Move to the start of substream `i`.
+		///
+		/// @pre `i` must be less than `num_substreams`. Larger values would
+		/// wrap around to an earlier substream.
+		void substream(std::uint64_t i)
+		{
+			assert(i < num_substreams);
+			counter = i * substream_length;
+		}
+
+		/// Advance the engine by `z` values.
+		void discard(unsigned long long z) { counter += z; }
+
+		/// Produce the next value.
+		result_type operator() ()
+		{
+			// SplitMix64: the counter is scaled by an odd constant and offset
+			// by the key, which is a bijection on 64-bit integers.
+			return mix(key + ++counter * 0x9e3779b97f4a7c15);
+		}
+
+	private:
+		std::uint64_t key{0};
+		std::uint64_t counter{0};
+
+		/// The SplitMix64 finaliser, which is also a bijection.
+		static std::uint64_t mix(std::uint64_t z)
+		{
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+			return z ^ (z >> 31);
+		}
+	};
+
+	/// Compute the full 128-bit product of `a` and `b`, storing the high and
+	/// low 64 bits in `hi` and `lo`.
+	inline void multiply_wide(std::uint64_t a, std::uint64_t b, std::uint64_t & hi, std::uint64_t & lo)
+	{
+		constexpr std::uint64_t mask = 0xffffffff;
+
+		std::uint64_t p0 = (a & mask) * (b & mask);
+		std::uint64_t p1 = (a & mask) * (b >> 32);
+		std::uint64_t p2 = (a >> 32) * (b & mask);
+		std::uint64_t p3 = (a >> 32) * (b >> 32);
+
+		std::uint64_t mid = (p0 >> 32) + (p1 & mask) + (p2 & mask);
+		lo = (mid << 32) | (p0 & mask);
+		hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+	}
+
+	/// Draw an integer uniformly from 0 to `range - 1` using `eng`.
+	///
+	/// This uses Lemire's multiply-and-reject method, which usually needs a
+	/// single value from `eng`. Unlike `std::uniform_int_distribution`,
+	/// whose mapping is up to the standard library, the result is fixed by
+	/// this function, so a substream rolls the same way with any toolchain.
+	///
+	/// @pre `Engine` must produce every 64-bit value with equal probability,
+	/// and `range` must be greater than zero.
+	template <typename Engine>
+	std::uint64_t uniform_below(Engine & eng, std::uint64_t range)
+	{
+		static_assert(Engine::min() == 0 && Engine::max() == std::numeric_limits<std::uint64_t>::max(),
+			"uniform_below needs an engine producing 64-bit values");
+		assert(range > 0);
+
+		std::uint64_t hi, lo;
+		multiply_wide(eng(), range, hi, lo);
+
+		// Reject the values that would make some results more likely than
+		// others. There are 2^64 mod range of them.
+		if (lo < range) {
+			std::uint64_t threshold = (0 - range) % range;
+			while (lo < threshold) multiply_wide(eng(), range, hi, lo);
+		}
+
+		return hi;
+	}
+
+	/// The engine used when rolling dice.
 	///
 	/// This needs to be seeded at some point before use.
-	inline std::mt19937 rand_eng;
-	
+	inline counter_engine rand_eng;
+
+	/// The type of value used to seed `rand_eng` deterministically.
+	using seed_type = std::uint64_t;
+
+	/// Produce a seed from a `random_device`.
+	inline seed_type random_seed() {
+		std::random_device rd;
+		auto hi = static_cast<seed_type>(rd());
+		auto lo = static_cast<seed_type>(rd());
+		return (hi << 32) | lo;
+	}
+
 	/// Seed `rand_eng` with a value from a `random_device`.
 	inline void seed() {
-		std::random_device rd;
-		rand_eng.seed(rd());
+		rand_eng.seed(random_seed());
+	}
+
+	/// Seed `rand_eng` with `value`, so that the same sequence of rolls is
+	/// produced each time the program is run with this value.
+	inline void seed(seed_type value) {
+		rand_eng.seed(value);
 	}
 }
 
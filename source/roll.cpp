@@ -0,0 +1,31 @@
+#include "roll.hpp"
+
+using namespace dice;
+
+void dice::roll_dice(std::vector<die> const& dice, counter_engine & eng, std::vector<die::result_type> & rolls)
+{
+	rolls.clear();
+	for (auto & d : dice) rolls.push_back(d(eng));
+}
+
+void dice::roll_row(std::vector<die> const& dice, counter_engine & eng, std::uint64_t row, die::result_type * out)
+{
+	eng.substream(row);
+	for (auto & d : dice) *out++ = d(eng);
+}
+
+histogram dice::roll_histogram(std::vector<die> const& dice, counter_engine & eng, row_range rows)
+{
+	histogram h;
+	h.rows = rows;
+
+	for (auto r = rows.begin; r != rows.end; ++r) {
+		eng.substream(r);
+
+		long long sum = 0;
+		for (auto & d : dice) sum += d(eng);
+		++h.counts[sum];
+	}
+
+	return h;
+}
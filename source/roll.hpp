@@ -0,0 +1,45 @@
+#ifndef DICE_ROLL
+#define DICE_ROLL
+
+#include <cstdint>
+#include <vector>
+
+#include "die.hpp"
+#include "histogram.hpp"
+#include "random.hpp"
+
+namespace dice {
+	/// Roll each of the given dice using `eng`, and store each roll in
+	/// `rolls` in the same order as the corresponding dice.
+	///
+	/// Any previous contents of `rolls` are discarded, but its capacity is
+	/// reused.
+	void roll_dice(
+		std::vector<die> const& dice,
+		counter_engine & eng,
+		std::vector<die::result_type> & rolls);
+
+	/// Roll row `row` of a run, storing the roll of `dice[i]` in `out[i]`.
+	///
+	/// The row is rolled from substream `row` of `eng`, so the rolls do not
+	/// depend on which other rows are rolled, or in which order.
+	///
+	/// `out` must have room for `dice.size()` rolls.
+	void roll_row(
+		std::vector<die> const& dice,
+		counter_engine & eng,
+		std::uint64_t row,
+		die::result_type * out);
+
+	/// Roll each row in `rows` as for `roll_row`, and count the number of
+	/// times each sum is rolled.
+	///
+	/// The seed, dice and total number of rows of the returned histogram
+	/// are left for the caller to fill in.
+	histogram roll_histogram(
+		std::vector<die> const& dice,
+		counter_engine & eng,
+		row_range rows);
+}
+
+#endif
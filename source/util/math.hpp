@@ -12,6 +12,14 @@ namespace dice {
 			while (x != 0) { x /= 10; ++n; }
 			return n;
 		}
+		
+		/// Compute the number of characters needed to write `x` in base 10,
+		/// including a leading '-' if `x` is negative.
+		template <typename Integer>
+		Integer num_chars(Integer x) {
+			if (x == 0) return 1;
+			return num_digits(x) + (x < 0 ? 1 : 0);
+		}
 	}
 }
 
@@ -2,8 +2,8 @@
 
 #include <cctype>
 
-std::vector<std::string_view> dice::util::split_and_prune(std::string_view str) {
-	auto substrings = std::vector<std::string_view>{};
+void dice::util::split_and_prune(std::string_view str, std::vector<std::string_view> & substrings) {
+	substrings.clear();
 	
 	auto i = str.begin();
 	auto j = i;
@@ -19,25 +19,41 @@ std::vector<std::string_view> dice::util::split_and_prune(std::string_view str)
 	}
 	
 	if (i != j) substrings.emplace_back(i, j-i);
-	
-	return substrings;
 }
 
-std::from_chars_result dice::util::from_chars(std::string_view str, int & value, int base)
-{
-	int new_value;
-	auto result = std::from_chars(str.begin(), str.end(), new_value, base);
+namespace {
+	template <typename Integer>
+	std::from_chars_result from_chars_impl(std::string_view str, Integer & value, int base)
+	{
+		Integer new_value;
+		auto result = std::from_chars(str.begin(), str.end(), new_value, base);
 
-	// Check for success of std::from_chars. Raise an additional error if
-	// not all of the characters in str have been used.
+		// Check for success of std::from_chars. Raise an additional error if
+		// not all of the characters in str have been used.
 
-	if (result.ec == std::errc{}) {
-		if (result.ptr == str.end()) {
-			value = new_value;
-		} else {
-			result.ec = std::errc::invalid_argument;
+		if (result.ec == std::errc{}) {
+			if (result.ptr == str.end()) {
+				value = new_value;
+			} else {
+				result.ec = std::errc::invalid_argument;
+			}
 		}
+
+		return result;
 	}
+}
+
+std::from_chars_result dice::util::from_chars(std::string_view str, int & value, int base)
+{
+	return from_chars_impl(str, value, base);
+}
 
-	return result;
+std::from_chars_result dice::util::from_chars(std::string_view str, long long & value, int base)
+{
+	return from_chars_impl(str, value, base);
+}
+
+std::from_chars_result dice::util::from_chars(std::string_view str, std::uint64_t & value, int base)
+{
+	return from_chars_impl(str, value, base);
 }
@@ -2,17 +2,19 @@
 #define DICE_UTIL_STRING
 
 #include <charconv>
-#include <string>
+#include <cstdint>
 #include <string_view>
 #include <vector>
 
 namespace dice {
 	namespace util {
-		/// Split `str` into the vector of non-empty substrings that are
-		/// delimited by whitespace in `str`.
+		/// Split `str` into the non-empty substrings that are delimited by
+		/// whitespace in `str`, and store them in `substrings`.
 		///
-		/// Empty substrings are automatically removed.
-		std::vector<std::string_view> split_and_prune(std::string_view str);
+		/// Empty substrings are automatically removed. Any previous contents
+		/// of `substrings` are discarded, but its capacity is reused, so no
+		/// memory is allocated once it is large enough.
+		void split_and_prune(std::string_view str, std::vector<std::string_view> & substrings);
 
 		/// Convert `str` into an int, using the given numeric base, and store
 		/// the result in `value`.
@@ -22,16 +24,20 @@ namespace dice {
 		/// in `str` were used. If this happens, `value` will be left
 		/// unchanged.
 		std::from_chars_result from_chars(std::string_view str, int & value, int base = 10);
-		
-		/// Insert copies of `ch` at the front of `str` until its length is at
-		/// least `min_l`.
+
+		/// Convert `str` into a long long, using the given numeric base, and
+		/// store the result in `value`.
+		///
+		/// Errors are flagged in the same way as for the overload taking an
+		/// int.
+		std::from_chars_result from_chars(std::string_view str, long long & value, int base = 10);
+
+		/// Convert `str` into a `std::uint64_t`, using the given numeric base,
+		/// and store the result in `value`.
 		///
-		/// If `str.size()` is already `min_l` or more, this function has no
-		/// effect.
-		inline void pad_front(std::string & str, char ch, std::string::size_type min_l = 1)
-		{
-			str.insert(0, (str.size() < min_l) ? (min_l - str.size()) : 0, ch);
-		}
+		/// Errors are flagged in the same way as for the overload taking an
+		/// int.
+		std::from_chars_result from_chars(std::string_view str, std::uint64_t & value, int base = 10);
 	}
 }
 
@@ -0,0 +1,183 @@
+// Tests of the C API in libdice.h, against `roll_row` and the dice program.
+//
+// Usage: capitest <path to dice>
+//
+// The following are checked:
+//  - after `dice_pool_seed(pool, S)`, the rows rolled match `roll_row` on
+//    a `counter_engine` seeded with S, and the output of
+//    `dice --seed=S --rolls=N -q`,
+//  - rolling in several calls continues from the last row rolled, and
+//    reseeding restarts from row 0,
+//  - a roll that would pass `DICE_POOL_MAX_ROWS` fails without writing,
+//  - invalid dice are rejected by `dice_pool_create`.
+//
+// The program exits with a non-zero status if any test fails.
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "die.hpp"
+#include "info.hpp"
+#include "libdice.h"
+#include "random.hpp"
+#include "roll.hpp"
+
+using namespace dice;
+
+namespace {
+	/// The seed used for every test.
+	constexpr std::uint64_t test_seed = 0x5eed'd1ce;
+
+	/// The number of rows rolled by each test.
+	constexpr std::size_t num_rows = 1000;
+
+	/// The sides of the dice in the pool.
+	std::vector<int> const test_sides{6, 20, 100, 1, 2147483647};
+
+	/// Keeps track of how many tests pass and fail.
+	struct report {
+		int passed{0};
+		int failed{0};
+
+		void check(std::string_view name, bool ok)
+		{
+			(ok ? passed : failed) += 1;
+			std::cout << (ok ? "PASS  " : "FAIL  ") << name << "\n";
+		}
+	};
+
+	/// Roll the next `rows` rows of `pool`, or return an empty vector if
+	/// `dice_pool_roll` fails.
+	std::vector<int> roll(dice_pool * pool, std::size_t rows)
+	{
+		std::vector<int> out(rows * dice_pool_size(pool));
+		if (dice_pool_roll(pool, rows, out.data()) != 0) out.clear();
+		return out;
+	}
+
+	/// The rows `begin` to `end - 1` rolled by `roll_row`.
+	std::vector<int> expected_rows(std::uint64_t seed, std::uint64_t begin, std::uint64_t end)
+	{
+		std::vector<die> dice(test_sides.begin(), test_sides.end());
+		counter_engine eng{seed};
+
+		std::vector<int> out((end - begin) * dice.size());
+		for (auto row = begin; row != end; ++row) {
+			roll_row(dice, eng, row, out.data() + (row - begin) * dice.size());
+		}
+		return out;
+	}
+
+	/// The rolls printed by `dice --seed=<seed> --rolls=<rows> -q`, or an
+	/// empty vector if the program could not be run.
+	std::vector<int> program_rows(std::string const& program, std::uint64_t seed, std::size_t rows)
+	{
+		std::ostringstream command;
+		command << program << " --seed=" << seed << " --rolls=" << rows << " -q";
+		for (int n : test_sides) command << " " << n;
+
+		std::FILE * pipe = popen(command.str().c_str(), "r");
+		if (!pipe) return {};
+
+		std::string output;
+		char buffer[4096];
+		for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0; ) {
+			output.append(buffer, n);
+		}
+		if (pclose(pipe) != 0) return {};
+
+		std::vector<int> out;
+		std::istringstream in{output};
+		for (int v; in >> v; ) out.push_back(v);
+		return out;
+	}
+}
+
+int main(int arg_c, char const* arg_v[])
+{
+	if (arg_c != 2) {
+		std::cerr << "Usage: " << arg_v[0] << " <path to dice>\n";
+		return 2;
+	}
+
+	report r;
+
+	r.check("dice_version", std::string_view{dice_version()} == version_c_str);
+
+	dice_pool * pool = dice_pool_create(test_sides.data(), test_sides.size());
+	if (!pool) {
+		std::cout << "FAIL  dice_pool_create\n";
+		return 1;
+	}
+
+	r.check("dice_pool_size", dice_pool_size(pool) == test_sides.size());
+
+	// The rows match both roll_row and the program.
+
+	dice_pool_seed(pool, test_seed);
+	auto rows = roll(pool, num_rows);
+	auto expected = expected_rows(test_seed, 0, num_rows);
+
+	r.check("dice_pool_roll matches roll_row", rows == expected);
+	r.check("dice_pool_roll matches dice -q", rows == program_rows(arg_v[1], test_seed, num_rows));
+
+	// Successive calls continue from the last row, and reseeding restarts
+	// from row 0.
+
+	r.check("dice_pool_roll continues", roll(pool, 10) == expected_rows(test_seed, num_rows, num_rows + 10));
+
+	dice_pool_seed(pool, test_seed);
+	std::vector<int> split;
+	for (std::size_t n : {std::size_t{1}, std::size_t{0}, std::size_t{99}, num_rows - 100}) {
+		auto part = roll(pool, n);
+		split.insert(split.end(), part.begin(), part.end());
+	}
+	r.check("dice_pool_roll in several calls", split == expected);
+
+	dice_pool_seed(pool, test_seed + 1);
+	r.check("dice_pool_seed with another seed", roll(pool, num_rows) == expected_rows(test_seed + 1, 0, num_rows));
+
+	// Rolling past the last row fails without writing anything, and leaves
+	// the pool where it was.
+
+	std::vector<int> sentinel(2 * test_sides.size(), -7);
+	auto buffer = sentinel;
+
+	// A size_t of 32 bits cannot ask for that many rows.
+
+	if constexpr (sizeof(std::size_t) > sizeof(std::uint32_t)) {
+		dice_pool_seed(pool, test_seed);
+		auto too_many = static_cast<std::size_t>(DICE_POOL_MAX_ROWS + 1);
+		r.check("dice_pool_roll past the limit",
+			dice_pool_roll(pool, too_many, buffer.data()) == -1 && buffer == sentinel);
+
+		roll(pool, num_rows);
+		auto remaining = static_cast<std::size_t>(DICE_POOL_MAX_ROWS - num_rows);
+		r.check("dice_pool_roll past the limit after rolling",
+			dice_pool_roll(pool, remaining + 1, buffer.data()) == -1 && buffer == sentinel);
+		r.check("dice_pool_roll after failing", roll(pool, 2) == expected_rows(test_seed, num_rows, num_rows + 2));
+	}
+
+	dice_pool_destroy(pool);
+
+	// Invalid dice are rejected.
+
+	for (int sides : {0, -1}) {
+		int const bad[] = {6, sides};
+		dice_pool * p = dice_pool_create(bad, 2);
+		r.check("dice_pool_create d" + std::to_string(sides), p == nullptr);
+		dice_pool_destroy(p);
+	}
+
+	dice_pool * empty = dice_pool_create(nullptr, 0);
+	r.check("dice_pool_create with no dice", empty && dice_pool_size(empty) == 0 && dice_pool_roll(empty, 5, nullptr) == 0);
+	dice_pool_destroy(empty);
+
+	std::cout << "\n" << r.passed << " passed, " << r.failed << " failed.\n";
+	return r.failed == 0 ? 0 : 1;
+}
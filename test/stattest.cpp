@@ -0,0 +1,552 @@
+// Statistical tests of the rolls produced by `die` and the bulk rolling
+// functions, using `counter_engine` with a fixed seed.
+//
+// Usage: stattest [--samples=<N>] [--threads=<T>]
+//
+// Each test draws N samples (default 2^22), split into a fixed number of
+// chunks. For single dice, chunk c is drawn from substream c of the engine;
+// for the bulk paths, each chunk is a block of rows. The results therefore
+// depend only on N, not on the number of threads. For each test,
+// the following are checked:
+//  - a chi-square test of the counts against the exact distribution,
+//  - a Kolmogorov-Smirnov test of the cumulative counts,
+//  - the correlation between consecutive rolls, and for the bulk paths,
+//    between dice in the same row and between consecutive rows.
+// A test also fails if any value falls outside the range that can be
+// rolled.
+// Large numbers of sides are grouped into at most 4096 bins of consecutive
+// values, whose exact probabilities are known. Since these bins only see
+// the high bits of each value, the values are also binned by their offset
+// modulo 4096 and given the same tests.
+//
+// The program exits with a non-zero status if any test fails.
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "die.hpp"
+#include "random.hpp"
+#include "roll.hpp"
+#include "util/string.hpp"
+
+using namespace dice;
+
+namespace {
+	/// The seed used for every test.
+	constexpr seed_type test_seed = 0x5eed'd1ce;
+
+	/// The number of chunks that each test is split into.
+	constexpr unsigned num_chunks = 64;
+
+	/// The most bins used for a single test.
+	constexpr std::uint64_t max_bins = 4096;
+
+	/// Limits beyond which a statistic is considered a failure. These are
+	/// far enough into the tails that a correct implementation passes with
+	/// overwhelming probability, even across every test.
+	constexpr double chi_square_limit = 5.0;
+	constexpr double ks_limit = 2.5;
+	constexpr double correlation_limit = 5.0;
+
+	/// Accumulates the sums needed for the correlation between pairs of
+	/// values.
+	struct correlation {
+		std::uint64_t n{0};
+		double sx{0}, sy{0}, sxx{0}, syy{0}, sxy{0};
+
+		void add(double x, double y)
+		{
+			++n;
+			sx += x; sy += y;
+			sxx += x * x; syy += y * y; sxy += x * y;
+		}
+
+		void merge(correlation const& other)
+		{
+			n += other.n;
+			sx += other.sx; sy += other.sy;
+			sxx += other.sxx; syy += other.syy; sxy += other.sxy;
+		}
+
+		/// The correlation scaled by the square root of the number of pairs,
+		/// which is approximately standard normal for independent values.
+		/// Returns 0 if either value is constant.
+		double z() const
+		{
+			double cov = sxy - sx * sy / n;
+			double vx = sxx - sx * sx / n;
+			double vy = syy - sy * sy / n;
+			if (n < 2 || vx <= 0 || vy <= 0) return 0;
+			return cov / std::sqrt(vx * vy) * std::sqrt(static_cast<double>(n));
+		}
+	};
+
+	/// The counts and correlations gathered by a test.
+	struct tally {
+		std::vector<std::uint64_t> counts;
+		std::vector<std::uint64_t> low_counts;   // Binned by the low bits, if used.
+		std::uint64_t out_of_range{0};   // Values that no die could roll.
+		correlation serial;     // Consecutive rolls of the same die.
+		correlation same_row;   // Different dice in the same row.
+
+		explicit tally(std::size_t bins = 0, std::size_t low_bins = 0)
+		: counts(bins), low_counts(low_bins)
+		{ }
+
+		void merge(tally const& other)
+		{
+			for (std::size_t i = 0; i < counts.size(); ++i) counts[i] += other.counts[i];
+			for (std::size_t i = 0; i < low_counts.size(); ++i) low_counts[i] += other.low_counts[i];
+			out_of_range += other.out_of_range;
+			serial.merge(other.serial);
+			same_row.merge(other.same_row);
+		}
+	};
+
+	/// A grouping of the values `lo` to `lo + range - 1` into equally sized
+	/// bins (up to rounding). If there are more values than bins, they are
+	/// also grouped into `low_bins` bins by their offset from `lo` modulo
+	/// `max_bins`.
+	struct binning {
+		long long lo;
+		std::uint64_t range;
+		std::uint64_t bins;
+		std::uint64_t low_bins;
+
+		binning(long long lo, std::uint64_t range)
+		: lo{lo}, range{range}, bins{std::min(range, max_bins)}, low_bins{range > max_bins ? max_bins : 0}
+		{ }
+
+		/// An empty tally with room for these bins.
+		tally empty() const { return tally{bins, low_bins}; }
+
+		/// Whether `v` is one of the values being binned.
+		bool contains(long long v) const
+		{
+			return v >= lo && static_cast<std::uint64_t>(v - lo) < range;
+		}
+
+		/// @pre `contains(v)` must be true.
+		std::size_t bin(long long v) const
+		{
+			return static_cast<std::size_t>(static_cast<std::uint64_t>(v - lo) * bins / range);
+		}
+
+		/// @pre `contains(v)` must be true, and `low_bins` must be non-zero.
+		std::size_t low_bin(long long v) const
+		{
+			return static_cast<std::size_t>(static_cast<std::uint64_t>(v - lo) % max_bins);
+		}
+
+		/// Add `v` to its bins in `t`, or count it as out of range.
+		void add(tally & t, long long v) const
+		{
+			if (contains(v)) {
+				++t.counts[bin(v)];
+				if (low_bins != 0) ++t.low_counts[low_bin(v)];
+			} else {
+				++t.out_of_range;
+			}
+		}
+
+		/// A value mapped into [-0.5, 0.5], for computing correlations.
+		double centred(long long v) const
+		{
+			return (static_cast<double>(v - lo) + 0.5) / static_cast<double>(range) - 0.5;
+		}
+
+		/// The exact probability of each bin.
+		std::vector<double> probabilities() const
+		{
+			// Bin b holds the offsets from ceil(b * range / bins) up to
+			// ceil((b + 1) * range / bins).
+			auto start = [&](std::uint64_t b) { return (b * range + bins - 1) / bins; };
+
+			std::vector<double> p;
+			for (std::uint64_t b = 0; b < bins; ++b) {
+				p.push_back(static_cast<double>(start(b + 1) - start(b)) / static_cast<double>(range));
+			}
+			return p;
+		}
+
+		/// The exact probability of each low bin.
+		std::vector<double> low_probabilities() const
+		{
+			// Low bin b holds the offsets b, b + max_bins, b + 2 * max_bins,
+			// and so on below range.
+			std::vector<double> p;
+			for (std::uint64_t b = 0; b < low_bins; ++b) {
+				p.push_back(static_cast<double>((range - 1 - b) / max_bins + 1) / static_cast<double>(range));
+			}
+			return p;
+		}
+	};
+
+	/// Run `work(c, part)` for each chunk `c`, spread across `threads`
+	/// threads, and merge the parts in chunk order. Each part starts as a
+	/// copy of `empty`.
+	template <typename Work>
+	tally run_chunks(tally const& empty, unsigned threads, Work work)
+	{
+		std::vector<tally> parts(num_chunks, empty);
+		std::vector<std::thread> pool;
+
+		for (unsigned t = 0; t < threads; ++t) {
+			pool.emplace_back([&, t] {
+				for (unsigned c = t; c < num_chunks; c += threads) work(c, parts[c]);
+			});
+		}
+		for (auto & th : pool) th.join();
+
+		tally result = empty;
+		for (auto & part : parts) result.merge(part);
+		return result;
+	}
+
+	/// The chi-square statistic of `counts` against `probs`, converted to an
+	/// approximately standard normal value with the Wilson-Hilferty
+	/// transformation.
+	double chi_square_z(std::vector<std::uint64_t> const& counts, std::vector<double> const& probs)
+	{
+		double n = 0;
+		for (auto c : counts) n += static_cast<double>(c);
+
+		// Bins that cannot be rolled carry no degrees of freedom.
+
+		double x = 0, k = -1;
+		for (std::size_t i = 0; i < counts.size(); ++i) {
+			if (probs[i] == 0) continue;
+
+			double expected = n * probs[i];
+			double diff = static_cast<double>(counts[i]) - expected;
+			x += diff * diff / expected;
+			k += 1;
+		}
+
+		if (k <= 0) return 0;
+
+		double v = 2 / (9 * k);
+		return (std::cbrt(x / k) - (1 - v)) / std::sqrt(v);
+	}
+
+	/// The Kolmogorov-Smirnov statistic of `counts` against `probs`, scaled
+	/// by the square root of the sample size.
+	double ks_statistic(std::vector<std::uint64_t> const& counts, std::vector<double> const& probs)
+	{
+		double n = 0;
+		for (auto c : counts) n += static_cast<double>(c);
+
+		double d = 0, observed = 0, expected = 0;
+		for (std::size_t i = 0; i < counts.size(); ++i) {
+			observed += static_cast<double>(counts[i]) / n;
+			expected += probs[i];
+			d = std::max(d, std::abs(observed - expected));
+		}
+		return d * std::sqrt(n);
+	}
+
+	/// Keeps track of how many tests pass and fail.
+	struct report {
+		int passed{0};
+		int failed{0};
+
+		/// Check the counts in `t` against `probs`, and the low counts
+		/// against `low_probs`, along with any correlations that were
+		/// gathered, and print a line for `name`.
+		void check(std::string_view name, tally const& t, std::vector<double> const& probs,
+			std::vector<double> const& low_probs = {})
+		{
+			double chi = chi_square_z(t.counts, probs);
+			double ks = ks_statistic(t.counts, probs);
+			double low_chi = t.low_counts.empty() ? 0 : chi_square_z(t.low_counts, low_probs);
+			double low_ks = t.low_counts.empty() ? 0 : ks_statistic(t.low_counts, low_probs);
+			double serial = t.serial.z();
+			double same_row = t.same_row.z();
+
+			bool ok = t.out_of_range == 0
+			       && std::abs(chi) < chi_square_limit && ks < ks_limit
+			       && std::abs(low_chi) < chi_square_limit && low_ks < ks_limit
+			       && std::abs(serial) < correlation_limit && std::abs(same_row) < correlation_limit;
+
+			// Every sample must land in a bin that can actually be rolled.
+			for (std::size_t i = 0; i < probs.size(); ++i) {
+				if (probs[i] == 0 && t.counts[i] != 0) ok = false;
+			}
+			for (std::size_t i = 0; i < t.low_counts.size(); ++i) {
+				if (low_probs[i] == 0 && t.low_counts[i] != 0) ok = false;
+			}
+
+			(ok ? passed : failed) += 1;
+
+			std::cout << (ok ? "PASS  " : "FAIL  ") << std::left << std::setw(32) << name << std::right
+			          << std::fixed << std::setprecision(2)
+			          << "  chi2 z=" << std::setw(6) << chi
+			          << "  ks=" << std::setw(5) << ks;
+			if (!t.low_counts.empty()) {
+				std::cout << "  low chi2 z=" << std::setw(6) << low_chi
+				          << "  low ks=" << std::setw(5) << low_ks;
+			}
+			if (t.serial.n > 0) std::cout << "  serial z=" << std::setw(6) << serial;
+			if (t.same_row.n > 0) std::cout << "  row z=" << std::setw(6) << same_row;
+			if (t.out_of_range > 0) std::cout << "  out of range=" << t.out_of_range;
+			std::cout << "\n";
+		}
+	};
+
+	/// The numbers of sides that are tested.
+	std::vector<int> const test_sides{
+		1, 2, 3, 6, 7,
+		15, 16, 17,
+		255, 256, 257,
+		65535, 65536, 65537,
+		1 << 20,
+		(1 << 30) - 1, 1 << 30, (1 << 30) + 1,
+		INT_MAX,
+	};
+
+	/// The largest number of faces for which an alias table is tested.
+	constexpr int max_alias_faces = 1 << 20;
+
+	/// Draw `samples` rolls of `d` and check them against `probs` and
+	/// `low_probs`, binned with `bs`. Consecutive rolls within each chunk
+	/// are tested for serial correlation.
+	void test_die(report & r, std::string const& name, die const& d, binning const& bs,
+		std::vector<double> const& probs, std::vector<double> const& low_probs,
+		std::uint64_t samples, unsigned threads)
+	{
+		auto t = run_chunks(bs.empty(), threads, [&](unsigned c, tally & part) {
+			auto local = d;
+			counter_engine eng{test_seed};
+			eng.substream(c);
+
+			auto n = samples / num_chunks + (c < samples % num_chunks ? 1 : 0);
+			long long prev = local(eng);
+			bs.add(part, prev);
+
+			for (std::uint64_t i = 1; i < n; ++i) {
+				long long v = local(eng);
+				bs.add(part, v);
+				part.serial.add(bs.centred(prev), bs.centred(v));
+				prev = v;
+			}
+		});
+
+		r.check(name, t, probs, low_probs);
+	}
+
+	/// Test a standard die with `n` sides, rolled by `die::operator()`.
+	void test_standard_die(report & r, int n, std::uint64_t samples, unsigned threads)
+	{
+		binning bs{1, static_cast<std::uint64_t>(n)};
+		test_die(r, "die d" + std::to_string(n), die{n}, bs, bs.probabilities(), bs.low_probabilities(), samples, threads);
+	}
+
+	/// Test a die with faces 1 to `n` of equal weight, which is rolled through
+	/// its alias table.
+	void test_alias_uniform(report & r, int n, std::uint64_t samples, unsigned threads)
+	{
+		std::vector<die::result_type> faces;
+		for (int i = 1; i <= n; ++i) faces.push_back(i);
+		std::vector<die::weight_type> weights(faces.size(), 1);
+
+		binning bs{1, static_cast<std::uint64_t>(n)};
+		test_die(r, "alias d" + std::to_string(n), die{faces, weights}, bs,
+			bs.probabilities(), bs.low_probabilities(), samples, threads);
+	}
+
+	/// Test a weighted die, which is rolled through its alias table.
+	void test_alias_weighted(report & r, std::string const& name,
+		std::vector<die::result_type> faces, std::vector<die::weight_type> weights,
+		std::uint64_t samples, unsigned threads)
+	{
+		auto [lo, hi] = std::minmax_element(faces.begin(), faces.end());
+		binning bs{*lo, static_cast<std::uint64_t>(static_cast<long long>(*hi) - *lo) + 1};
+
+		die::weight_type total = 0;
+		for (auto w : weights) total += w;
+
+		std::vector<double> probs(bs.bins, 0.0), low_probs(bs.low_bins, 0.0);
+		for (std::size_t i = 0; i < faces.size(); ++i) {
+			auto p = static_cast<double>(weights[i]) / static_cast<double>(total);
+			probs[bs.bin(faces[i])] += p;
+			if (bs.low_bins != 0) low_probs[bs.low_bin(faces[i])] += p;
+		}
+
+		test_die(r, name, die{faces, weights}, bs, probs, low_probs, samples, threads);
+	}
+
+	/// Test `roll_row` on two standard dice with `n` sides, over `rows` rows
+	/// split into contiguous blocks. Both dice are binned together, and the
+	/// correlations between the dice in each row and between the first die
+	/// of consecutive rows (i.e. consecutive substreams) are tested.
+	void test_roll_row(report & r, int n, std::uint64_t rows, unsigned threads)
+	{
+		std::vector<die> dice{die{n}, die{n}};
+		binning bs{1, static_cast<std::uint64_t>(n)};
+
+		auto t = run_chunks(bs.empty(), threads, [&](unsigned c, tally & part) {
+			auto local = dice;
+			counter_engine eng{test_seed};
+			auto begin = rows * c / num_chunks;
+			auto end = rows * (c + 1) / num_chunks;
+
+			die::result_type out[2];
+			double prev = 0;
+
+			for (auto row = begin; row != end; ++row) {
+				roll_row(local, eng, row, out);
+				bs.add(part, out[0]);
+				bs.add(part, out[1]);
+
+				part.same_row.add(bs.centred(out[0]), bs.centred(out[1]));
+				if (row != begin) part.serial.add(prev, bs.centred(out[0]));
+				prev = bs.centred(out[0]);
+			}
+		});
+
+		r.check("roll_row 2d" + std::to_string(n), t, bs.probabilities(), bs.low_probabilities());
+	}
+
+	/// The exact distribution of the sum of `dice`, by convolution, indexed
+	/// from the smallest possible sum.
+	std::vector<double> sum_distribution(std::vector<die> const& dice)
+	{
+		std::vector<double> dist{1.0};
+
+		for (auto & d : dice) {
+			std::vector<double> faces(static_cast<std::size_t>(d.max() - d.min() + 1), 0.0);
+			if (d.is_standard()) {
+				std::fill(faces.begin(), faces.end(), 1.0 / d.sides());
+			} else {
+				die::weight_type total = 0;
+				for (auto w : d.weights()) total += w;
+				for (std::size_t i = 0; i < d.faces().size(); ++i) {
+					faces[static_cast<std::size_t>(d.faces()[i] - d.min())]
+						+= static_cast<double>(d.weights()[i]) / static_cast<double>(total);
+				}
+			}
+
+			std::vector<double> next(dist.size() + faces.size() - 1, 0.0);
+			for (std::size_t i = 0; i < dist.size(); ++i) {
+				for (std::size_t j = 0; j < faces.size(); ++j) next[i + j] += dist[i] * faces[j];
+			}
+			dist = std::move(next);
+		}
+
+		return dist;
+	}
+
+	/// Test `roll_histogram` on `dice` against the exact distribution of
+	/// their sum, and check that it agrees with `roll_row` on the first
+	/// rows.
+	void test_roll_histogram(report & r, std::string const& name, std::vector<die> const& dice,
+		std::uint64_t rows, unsigned threads)
+	{
+		long long min_sum = 0;
+		for (auto & d : dice) min_sum += d.min();
+
+		auto probs = sum_distribution(dice);
+
+		auto t = run_chunks(tally{probs.size()}, threads, [&](unsigned c, tally & part) {
+			auto local = dice;
+			counter_engine eng{test_seed};
+			row_range range{
+				static_cast<long long>(rows * c / num_chunks),
+				static_cast<long long>(rows * (c + 1) / num_chunks)};
+
+			histogram h = roll_histogram(local, eng, range);
+			for (auto [sum, count] : h.counts) {
+				if (sum >= min_sum && static_cast<std::size_t>(sum - min_sum) < probs.size()) {
+					part.counts[static_cast<std::size_t>(sum - min_sum)] += static_cast<std::uint64_t>(count);
+				} else {
+					part.out_of_range += static_cast<std::uint64_t>(count);
+				}
+			}
+		});
+
+		// Both bulk paths must produce the same rolls for the same rows.
+
+		counter_engine eng{test_seed};
+		histogram h = roll_histogram(dice, eng, {0, 1000});
+		std::vector<die::result_type> out(dice.size());
+		for (long long row = 0; row < 1000; ++row) {
+			roll_row(dice, eng, static_cast<std::uint64_t>(row), out.data());
+
+			long long sum = 0;
+			for (auto v : out) sum += v;
+			if (--h.counts[sum] == 0) h.counts.erase(sum);
+		}
+
+		if (!h.counts.empty()) {
+			std::cout << "FAIL  " << name << ": roll_histogram and roll_row disagree\n";
+			r.failed += 1;
+		}
+
+		r.check(name, t, probs);
+	}
+}
+
+int main(int arg_c, char const* arg_v[])
+{
+	std::uint64_t samples = std::uint64_t{1} << 22;
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+	for (int i = 1; i < arg_c; ++i) {
+		std::string_view arg = arg_v[i];
+		bool ok = false;
+
+		if (arg.rfind("--samples=", 0) == 0) {
+			ok = util::from_chars(arg.substr(10), samples).ec == std::errc{} && samples >= num_chunks;
+		} else if (int t; arg.rfind("--threads=", 0) == 0) {
+			ok = util::from_chars(arg.substr(10), t).ec == std::errc{} && t > 0;
+			if (ok) threads = static_cast<unsigned>(t);
+		}
+
+		if (!ok) {
+			std::cerr << "Usage: " << arg_v[0] << " [--samples=<N>] [--threads=<T>]\n";
+			return 2;
+		}
+	}
+
+	std::cout << "Seed " << test_seed << ", " << samples << " samples per test, "
+	          << threads << " thread(s).\n\n";
+
+	report r;
+
+	// die::operator() on standard dice.
+
+	for (int n : test_sides) test_standard_die(r, n, samples, threads);
+
+	// alias_table, through die::operator() on custom dice.
+
+	for (int n : test_sides) {
+		if (n <= max_alias_faces) test_alias_uniform(r, n, samples, threads);
+	}
+
+	test_alias_weighted(r, "alias Fudge [-1,0,1]", {-1, 0, 1}, {1, 1, 1}, samples, threads);
+	test_alias_weighted(r, "alias [1:1,...,6:6]", {1, 2, 3, 4, 5, 6}, {1, 2, 3, 4, 5, 6}, samples, threads);
+	test_alias_weighted(r, "alias [3,1,4,1,5,9,2] wts", {1, 2, 3, 4, 5, 6, 7}, {3, 1, 4, 1, 5, 9, 2}, samples, threads);
+	test_alias_weighted(r, "alias [0:1000,1]", {0, 1}, {1000, 1}, samples, threads);
+	test_alias_weighted(r, "alias [-2^31,2^31-1]", {INT_MIN, INT_MAX}, {1, 2}, samples, threads);
+
+	// roll_row and roll_histogram, the bulk paths.
+
+	for (int n : test_sides) test_roll_row(r, n, samples / 2, threads);
+
+	test_roll_histogram(r, "roll_histogram 3d6", {die{6}, die{6}, die{6}}, samples, threads);
+	test_roll_histogram(r, "roll_histogram 4dF",
+		std::vector<die>(4, die{{-1, 0, 1}, {1, 1, 1}}), samples, threads);
+	test_roll_histogram(r, "roll_histogram d20+d[1:1..6:6]",
+		{die{20}, die{{1, 2, 3, 4, 5, 6}, {1, 2, 3, 4, 5, 6}}}, samples, threads);
+
+	std::cout << "\n" << r.passed << " passed, " << r.failed << " failed.\n";
+	return r.failed == 0 ? 0 : 1;
+}